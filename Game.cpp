@@ -1,61 +1,75 @@
 #include <Arduino.h>
-#include "Graphics.h"
-#include "Keypad.h"
+#include "Game.h"
+#include "Tracer.h"
 
+// Gravity and scoring, the host simulator overrides these to tune them
+#ifndef DEFAULT_DROP_INTERVAL
 #define DEFAULT_DROP_INTERVAL 500 // Unit: millisecond
+#endif
+#ifndef DROP_INTERVAL_PER_MODE
+#define DROP_INTERVAL_PER_MODE 150 // Faster by this much per game mode
+#endif
+#ifndef DROP_INTERVAL_STEP
+#define DROP_INTERVAL_STEP 10 // Faster by this much per level
+#endif
+#ifndef MIN_DROP_INTERVAL
+#define MIN_DROP_INTERVAL 50
+#endif
+#ifndef LINES_PER_LEVEL
+#define LINES_PER_LEVEL 10
+#endif
+// Award of 1, 2, 3 and 4 lines eliminated at once, times (award_factor + 1)
+#ifndef SCORE_LINES_1
+#define SCORE_LINES_1 40
+#endif
+#ifndef SCORE_LINES_2
+#define SCORE_LINES_2 100
+#endif
+#ifndef SCORE_LINES_3
+#define SCORE_LINES_3 300
+#endif
+#ifndef SCORE_LINES_4
+#define SCORE_LINES_4 1200
+#endif
 
-static struct {
-    bool is_started;
-    game_mode mode;
-    unsigned int score, award_factor;
-    unsigned int line_eliminated;
-    unsigned long start_time;
-    unsigned long drop_interval;
-    piece_type next_piece_type;
-} game_status;
-
-// There are 2 (NUM_OF_BLOCK_FOR_PIECE_ENVELOPE / 2) invisible blocks on the left
-// and on the right, marked with BLOCK_INACTIVE (the same as blocks that already landed),
-// to simplify the collision detection for the leftmost and rightmost pieces when doing rotation. 
-
-// As the same way, there are 1 dummy block at the bottom as playground's bottom border, 
-// and 4 dummy blocks at the top (NUM_OF_BLOCK_FOR_PIECE_ENVELOPE) to detect "block overflow" (game-over)
-static block_status playground_block_buffer[1 + 20 + 4][2 + 10 + 2];
-
-void _init_playground(void){
+void _init_playground(game_instance *game){
     block_status status;
     unsigned char x, y;
     for (y = 0; y < 24; y++){
         for (x = 0; x < 14; x++){
+            // Side borders go up through the invisible layers as well,
+            // or a piece just loaded could slide over the top of them
             if(y == 0) status = BLOCK_INACTIVE;
-            else if((x < 2) && (y < 1 + 20))
-                status = BLOCK_INACTIVE;
-            else if((x >= 2 + 10) && (y < 1 + 20))
-                status = BLOCK_INACTIVE;
+            else if(x < 2) status = BLOCK_INACTIVE;
+            else if(x >= 2 + 10) status = BLOCK_INACTIVE;
             else status = NO_BLOCK;
-            playground_block_buffer[y][x] = status;
+            game->playground_block_buffer[y][x] = status;
         }
     }
 }
 
-void _draw_playground(void) {
+void _draw_playground(game_instance *game) {
     unsigned char x, y;
-    block_status block_status_layer[10], block;
+    unsigned int block_mask;
+    block_status block;
     for(y = 1; y < 21; y++){
         // Scan the layer to find if there's need to update the screen
         for(x = 2; x < 12; x++){
-            block = playground_block_buffer[y][x];
+            block = game->playground_block_buffer[y][x];
             if((block == BLOCK_TO_CLEAN) ||
                (block == BLOCK_TO_DRAW)) break;
         }
-        if(x == 13) continue; // This layer needn't to redraw
+        if(x == 12) continue; // This layer needn't to redraw
+        block_mask = 0;
         for(x = 2; x < 12; x++){
-            block_status_layer[x - 2] = playground_block_buffer[y][x];
+            block = game->playground_block_buffer[y][x];
             // Block that clean from screen is no needed to update next frame
-            if(playground_block_buffer[y][x] == BLOCK_TO_CLEAN)
-                playground_block_buffer[y][x] = NO_BLOCK;
+            if(block == BLOCK_TO_CLEAN)
+                game->playground_block_buffer[y][x] = NO_BLOCK;
+            else if(block != NO_BLOCK)
+                block_mask |= 1 << (x - 2);
         }
-        draw_playground_layer(y - 1, block_status_layer);
+        draw_playground_layer(y - 1, block_mask);
     }
 }
 
@@ -75,15 +89,19 @@ const unsigned char piece_block_map[8][16] = {
     {0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0}
 };
 
-typedef struct {
-    unsigned char block_map[4][4];
-    char pos_x, pos_y; // pos_y may be minus
-} piece_info;
-
-piece_info piece_active, piece_backup;
+// Xorshift32, kept per game instance so that seeded games are reproducible
+// (and independent of each other when several games run at the same time)
+piece_type _random_piece(game_instance *game){
+    uint32_t x = game->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    game->random_state = x;
+    return (piece_type)(x >> 29); // Top 3 bits: one of the 8 pieces
+}
 
-void _write_piece_to_playground(piece_info *piece, block_status status){
-    char piece_x, piece_y;
+void _write_piece_to_playground(game_instance *game, piece_info *piece, block_status status){
+    signed char piece_x, piece_y;
     unsigned char offset_x, offset_y;
     unsigned char playground_x, playground_y;
     piece_x = piece->pos_x;
@@ -93,105 +111,122 @@ void _write_piece_to_playground(piece_info *piece, block_status status){
             playground_x = piece_x + offset_x;
             playground_y = piece_y + offset_y;
             if(piece->block_map[offset_x][offset_y])
-                playground_block_buffer[playground_y][playground_x] = status;
+                game->playground_block_buffer[playground_y][playground_x] = status;
         }
     }
 }
 
-void _update_piece_to_playground(bool to_inactive) {
+void _update_piece_to_playground(game_instance *game, bool to_inactive) {
     if(!to_inactive){
-        _write_piece_to_playground(&piece_backup, BLOCK_TO_CLEAN);
-        _write_piece_to_playground(&piece_active, BLOCK_TO_DRAW);
+        _write_piece_to_playground(game, &game->piece_backup, BLOCK_TO_CLEAN);
+        _write_piece_to_playground(game, &game->piece_active, BLOCK_TO_DRAW);
     }else{
-        _write_piece_to_playground(&piece_active, BLOCK_INACTIVE);
+        _write_piece_to_playground(game, &game->piece_active, BLOCK_INACTIVE);
     }
 }
 
 // Check collision between active piece and the playground part
-bool _check_collision(void) {
-    char piece_x, piece_y;
+bool _check_collision(game_instance *game) {
+    signed char piece_x, piece_y;
     unsigned char offset_x, offset_y;
     unsigned char playground_x, playground_y;
-    piece_x = piece_active.pos_x;
-    piece_y = piece_active.pos_y;
+    piece_x = game->piece_active.pos_x;
+    piece_y = game->piece_active.pos_y;
     for(offset_y = 0; offset_y < 4; offset_y++){
         for(offset_x = 0; offset_x < 4; offset_x++){
-            if(!piece_active.block_map[offset_x][offset_y]) continue;
+            if(!game->piece_active.block_map[offset_x][offset_y]) continue;
+            // A rotation next to the bottom or left border may take
+            // a block out of the playground buffer
+            if((piece_x + offset_x < 0) || (piece_y + offset_y < 0))
+                return true;
             playground_x = piece_x + offset_x;
             playground_y = piece_y + offset_y;
-            if(playground_block_buffer[playground_y][playground_x] == BLOCK_INACTIVE)
+            if(game->playground_block_buffer[playground_y][playground_x] == BLOCK_INACTIVE)
                 return true;
         }
     }
     return false;
 }
 
-void _rotate_piece_active(void){
+void _rotate_piece_active(game_instance *game){
     unsigned char i, j, rotated_block_map[4][4] = {0};
     for (i = 0; i < 4; i++)
         for (j = 0; j < 4; j++)
-            rotated_block_map[j][i] = piece_active.block_map[4 - i - 1][j];
-    memcpy(piece_active.block_map, rotated_block_map, 16);
+            rotated_block_map[j][i] = game->piece_active.block_map[4 - i - 1][j];
+    memcpy(game->piece_active.block_map, rotated_block_map, 16);
 }
 
-void _load_new_piece(piece_type piece_type_to_load, bool is_on_screen) {
-    memcpy(piece_active.block_map, &piece_block_map[piece_type_to_load][0], 16);
-    // Piece default generation position: (5, 20) 
-    piece_active.pos_x = 5;
-    piece_active.pos_y = 20;
+void _load_new_piece(game_instance *game, piece_type piece_type_to_load, bool is_on_screen) {
+    memcpy(game->piece_active.block_map, &piece_block_map[piece_type_to_load][0], 16);
+    // Piece default generation position: (5, 20)
+    game->piece_active.pos_x = 5;
+    game->piece_active.pos_y = 20;
     if (is_on_screen) {
-        piece_backup = piece_active;
-        _write_piece_to_playground(&piece_active, BLOCK_TO_DRAW);
+        game->piece_backup = game->piece_active;
+        _write_piece_to_playground(game, &game->piece_active, BLOCK_TO_DRAW);
     }
 }
 
-void _set_game_mode(game_mode mode){
-    game_status.drop_interval = DEFAULT_DROP_INTERVAL - 150 * mode;
-    game_status.award_factor = mode;
+void _set_game_mode(game_instance *game, game_mode mode){
+    game->status.drop_interval = DEFAULT_DROP_INTERVAL - DROP_INTERVAL_PER_MODE * mode;
+    game->status.award_factor = mode;
 }
 
-static const unsigned int score_lut[4] = {40, 100, 300, 1200};
-void _update_score(unsigned char line_eliminated_once){
-    game_status.line_eliminated += line_eliminated_once;
+static const uint16_t score_lut[4] = {SCORE_LINES_1, SCORE_LINES_2, SCORE_LINES_3, SCORE_LINES_4};
+uint32_t get_award(uint16_t award_factor, unsigned char line_eliminated_once){
+    if(line_eliminated_once == 0) return 0;
     if(line_eliminated_once > 4) line_eliminated_once = 4;
-    game_status.score += score_lut[line_eliminated_once - 1] * (game_status.award_factor + 1);
-    if (game_status.line_eliminated % 10 == 0) {
-        game_status.award_factor++;
-        if(game_status.drop_interval <= 50)
-            game_status.drop_interval = 50;
-        else game_status.drop_interval -= 10;
+    return (uint32_t)score_lut[line_eliminated_once - 1] * (award_factor + 1);
+}
+
+void _update_score(game_instance *game, unsigned char line_eliminated_once){
+    // Nothing to award (and no level-up) for a piece that completes no line
+    if(line_eliminated_once == 0) return;
+    uint16_t level = game->status.line_eliminated / LINES_PER_LEVEL;
+    game->status.line_eliminated += line_eliminated_once;
+    // The 16-bit score wraps around past 65535, as it always did
+    game->status.score += get_award(game->status.award_factor, line_eliminated_once);
+    // Level up once every LINES_PER_LEVEL lines eliminated
+    if (game->status.line_eliminated / LINES_PER_LEVEL != level) {
+        game->status.award_factor++;
+        if(game->status.drop_interval < MIN_DROP_INTERVAL + DROP_INTERVAL_STEP)
+            game->status.drop_interval = MIN_DROP_INTERVAL;
+        else game->status.drop_interval -= DROP_INTERVAL_STEP;
     }
 }
 
-void _process_inactive_line() {
+void _process_inactive_line(game_instance *game) {
     unsigned char first_layer_to_check, last_layer_to_check;
     unsigned char layer_idx, block_idx;
     unsigned char line_eliminated_once = 0;
-    
+    block_status (*playground)[2 + 10 + 2] = game->playground_block_buffer;
+
     // Step 1: Clean all completed lines (may not continous) caused by this landed block
     // From the bottom-left corner of the landed piece,
     // i.e. the y_pos of piece_active to get the first layer to check,
     // and noted that we only check visiable layer
-    if (piece_active.pos_y < 1) first_layer_to_check = 1;
-    else first_layer_to_check = piece_active.pos_y;
-    last_layer_to_check = piece_active.pos_y + 4;
+    if (game->piece_active.pos_y < 1) first_layer_to_check = 1;
+    else first_layer_to_check = game->piece_active.pos_y;
+    last_layer_to_check = game->piece_active.pos_y + 4;
     for(layer_idx = first_layer_to_check; layer_idx < last_layer_to_check; layer_idx++) {
+        // Only landed blocks fill a line, invisible layers are never
+        // redrawn so they may still hold BLOCK_TO_CLEAN leftovers
         for(block_idx = 2; block_idx < 12; block_idx++)
-            if(playground_block_buffer[layer_idx][block_idx] == NO_BLOCK) break;
+            if(playground[layer_idx][block_idx] != BLOCK_INACTIVE) break;
         if (block_idx < 12) continue;
         // This line is fully filled and ready to be eliminated
         for (block_idx = 2; block_idx < 12; block_idx++)
-            playground_block_buffer[layer_idx][block_idx] = BLOCK_TO_CLEAN;
+            playground[layer_idx][block_idx] = BLOCK_TO_CLEAN;
         first_layer_to_check = layer_idx + 1;
         line_eliminated_once++;
-        _draw_playground();
+        _draw_playground(game);
     }
 
     // Step 2: Update the score
-    _update_score(line_eliminated_once);
-    draw_score(game_status.score);
+    _update_score(game, line_eliminated_once);
+    draw_score(game->status.score);
 
-    // Step 3: Move all remaining inactive pieces down 
+    // Step 3: Move all remaining inactive pieces down
     // to filled the blank(s) caused by eliminated layer(s)
     // The whole playground may need to be moved downwards
     unsigned char layer_to_copy_idx;
@@ -199,116 +234,157 @@ void _process_inactive_line() {
         // We will find all the eliminated layer(s) again, from bottom to top
         for (layer_idx = 1; layer_idx < 20; layer_idx++) {
             for(block_idx = 2; block_idx < 12; block_idx++)
-                if (playground_block_buffer[layer_idx][block_idx] != NO_BLOCK) break;
+                if (playground[layer_idx][block_idx] != NO_BLOCK) break;
             if(block_idx < 12) continue; // This layer is not an eliminated layer
             // Copy the content at the top of the eliminated layer to fill this empty layer
             for (layer_to_copy_idx = layer_idx + 1; layer_to_copy_idx < 20; layer_to_copy_idx++) {
                 for (block_idx = 2; block_idx < 12; block_idx++) {
-                    if (playground_block_buffer[layer_to_copy_idx][block_idx] == BLOCK_TO_DRAW ||
-                        playground_block_buffer[layer_to_copy_idx][block_idx] == BLOCK_INACTIVE)
-                        playground_block_buffer[layer_to_copy_idx - 1][block_idx] = BLOCK_TO_DRAW;
-                    else playground_block_buffer[layer_to_copy_idx - 1][block_idx] = BLOCK_TO_CLEAN;
+                    if (playground[layer_to_copy_idx][block_idx] == BLOCK_TO_DRAW ||
+                        playground[layer_to_copy_idx][block_idx] == BLOCK_INACTIVE)
+                        playground[layer_to_copy_idx - 1][block_idx] = BLOCK_TO_DRAW;
+                    else playground[layer_to_copy_idx - 1][block_idx] = BLOCK_TO_CLEAN;
                 }
             }
         }
-        // Make sure all active blocks become to inactive blocks, since all 
+        // Make sure all active blocks become to inactive blocks, since all
         // these blocks in the scene will become "the landed part" finally
-        for (char r = 1; r < 24; r++) {
-            for (char c = 2; c < 12; c++) {
-                if (playground_block_buffer[r][c] == BLOCK_TO_DRAW)
-                    playground_block_buffer[r][c] = BLOCK_INACTIVE;
+        for (unsigned char r = 1; r < 24; r++) {
+            for (unsigned char c = 2; c < 12; c++) {
+                if (playground[r][c] == BLOCK_TO_DRAW)
+                    playground[r][c] = BLOCK_INACTIVE;
             }
         }
-        _draw_playground();
+        _draw_playground(game);
     }
 }
 
-bool _process_movement(bool is_movement_down){
-    if (_check_collision()) {
-        piece_active = piece_backup;
+bool _process_movement(game_instance *game, bool is_movement_down){
+    if (_check_collision(game)) {
+        game->piece_active = game->piece_backup;
         // Piece touch-down with or without overflow
         if(is_movement_down){
             // In both cases, update the current piece to BLOCK_INACTIVE
-            _update_piece_to_playground(true);
+            _update_piece_to_playground(game, true);
+            game->status.piece_landed++;
             // Find possible completed line(s), remove it(them),
             // and calculated the score and update difficulty
-            _process_inactive_line();
+            _process_inactive_line(game);
             // Load a new tetris piece off-screen to detect overflow
             // Off-screen: not written to playground_block_buffer
-            _load_new_piece(game_status.next_piece_type, false);
+            _load_new_piece(game, game->status.next_piece_type, false);
             // Piece overflow, then game is over
-            if (_check_collision()){
+            if (_check_collision(game)){
                 draw_game_over();
                 return false;
             }
             // No overflow, then reload the new tetris on-screen
-            _load_new_piece(game_status.next_piece_type, true);
+            _load_new_piece(game, game->status.next_piece_type, true);
             // Reset key status to avoid unexpected
             // holding-key speed-up for newly created piece
-            reset_key_state(); 
-            game_status.next_piece_type = (piece_type)random(0, 8);
-            draw_next_piece_hint(game_status.next_piece_type);
+            reset_key_state();
+            game->status.next_piece_type = _random_piece(game);
+            draw_next_piece_hint(game->status.next_piece_type);
         }
     }else{
-        _update_piece_to_playground(false);
-        _draw_playground();
+        _update_piece_to_playground(game, false);
+        _draw_playground(game);
     }
     return true;
 }
 
+// Murmur3 finalizer: close seeds (e.g. seed, seed + 1, ...) give states
+// far apart, where xorshift32 would start them all on the same pieces
+uint32_t _mix_seed(uint32_t seed){
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6BUL;
+    seed ^= seed >> 13;
+    seed *= 0xC2B2AE35UL;
+    seed ^= seed >> 16;
+    return seed;
+}
+
+void init_game(game_instance *game, uint32_t seed) {
+    seed = _mix_seed(seed);
+    // Xorshift32 gets stuck at zero, so never seed with it
+    game->random_state = (seed == 0) ? 1 : seed;
+    game->status.is_started = false;
+    game->status.mode = EASY;
+    game->status.next_piece_type = _random_piece(game);
+    game->status.score = 0;
+    game->status.line_eliminated = 0;
+    game->status.piece_landed = 0;
+}
+
+void start_game(game_instance *game, game_mode mode) {
+    game->status.mode = mode;
+    _set_game_mode(game, mode);
+    game->status.is_started = true;
+    clear_screen();
+    draw_score(game->status.score);
+    draw_next_piece_hint(game->status.next_piece_type);
+    _init_playground(game);
+    _load_new_piece(game, _random_piece(game), true);
+    _draw_playground(game);
+}
+
+// Gravity: move the active piece one layer down
+bool drop_piece(game_instance *game) {
+    game->piece_backup = game->piece_active;
+    game->piece_active.pos_y -= 1;
+    return _process_movement(game, true);
+}
+
+bool move_piece(game_instance *game, key_type key) {
+    bool is_movement_down = false;
+    game->piece_backup = game->piece_active;
+    if(key == KEY_LEFT){
+        game->piece_active.pos_x -= 1;
+    }else if(key == KEY_RIGHT){
+        game->piece_active.pos_x += 1;
+    }else if(key == KEY_DOWN){
+        game->piece_active.pos_y -= 1;
+        is_movement_down = true;
+    }else if(key == KEY_ROTATE){
+        _rotate_piece_active(game);
+    }
+    return _process_movement(game, is_movement_down);
+}
+
+static game_instance game;
+
 void reset_game(void) {
-    game_status.is_started = false;
-    game_status.mode = EASY;
-    game_status.next_piece_type = (piece_type)random(0, 8);
-    game_status.score = 0;
-    game_status.line_eliminated = 0;
+    init_game(&game, random(0x7FFFFFFFL));
     clear_screen();
-    draw_score(game_status.score);
-    draw_next_piece_hint(game_status.next_piece_type);
-    draw_menu(game_status.mode);
+    draw_score(game.status.score);
+    draw_next_piece_hint(game.status.next_piece_type);
+    draw_menu(game.status.mode);
 }
 
 bool step_game(void){
     key_type key = read_key();
-    if(game_status.is_started){
-        if(millis() - game_status.start_time > game_status.drop_interval){
-            game_status.start_time = millis();
-            piece_backup = piece_active;
-            piece_active.pos_y -= 1;
-            return _process_movement(true);
+    if(game.status.is_started){
+        if(millis() - game.status.start_time > game.status.drop_interval){
+            game.status.start_time = millis();
+            // The key read (if any) is skipped in favour of gravity
+            TRACE_KEY_LOST();
+            return drop_piece(&game);
         }else if(key != NO_KEY){
-            bool is_movement_down = false;
-            piece_backup = piece_active;
-            if(key == KEY_LEFT){
-                piece_active.pos_x -= 1;
-            }else if(key == KEY_RIGHT){
-                piece_active.pos_x += 1;
-            }else if(key == KEY_DOWN){
-                piece_active.pos_y -= 1;
-                is_movement_down = true;
-            }else if(key == KEY_ROTATE){
-                _rotate_piece_active();
-            }
-            return _process_movement(is_movement_down);
+            bool is_alive = move_piece(&game, key);
+            TRACE_KEY_DONE();
+            return is_alive;
         }else return true;
     }else{
         if(key == NO_KEY) return true;
+        TRACE_KEY_CANCEL();
         if(key == KEY_DOWN){
-            if(game_status.mode == HARD)
-                game_status.mode = EASY;
-            else game_status.mode = (game_mode)(game_status.mode + 1);
-            draw_menu(game_status.mode);    
+            if(game.status.mode == HARD)
+                game.status.mode = EASY;
+            else game.status.mode = (game_mode)(game.status.mode + 1);
+            draw_menu(game.status.mode);
         }else if(key == KEY_ROTATE){
-            _set_game_mode(game_status.mode);
-            game_status.is_started = true;
-            game_status.start_time = millis();
-            clear_screen();
-            draw_score(game_status.score);
-            draw_next_piece_hint(game_status.next_piece_type);
-            _init_playground();
-            _load_new_piece((piece_type)random(0, 8), true);
-            _draw_playground();
+            start_game(&game, game.status.mode);
+            game.status.start_time = millis();
         }
         return true;
     }
-}
\ No newline at end of file
+}
@@ -1,7 +1,51 @@
 #ifndef _GAME_H_
 #define _GAME_H_
 
+#include <stdint.h>
+#include "Graphics.h"
+#include "Keypad.h"
+
+typedef struct {
+    unsigned char block_map[4][4];
+    signed char pos_x, pos_y; // pos_y may be minus
+} piece_info;
+
+// Everything a single game needs, so that several games can be
+// played side by side (e.g. by the host-side batch simulator)
+// Fixed-width fields: the host build must wrap exactly like the AVR
+typedef struct {
+    struct {
+        bool is_started;
+        game_mode mode;
+        uint16_t score, award_factor;
+        uint16_t line_eliminated;
+        uint16_t piece_landed;
+        uint32_t start_time;
+        uint32_t drop_interval;
+        piece_type next_piece_type;
+    } status;
+    // There are 2 (NUM_OF_BLOCK_FOR_PIECE_ENVELOPE / 2) invisible blocks on the left
+    // and on the right, marked with BLOCK_INACTIVE (the same as blocks that already landed),
+    // to simplify the collision detection for the leftmost and rightmost pieces when doing rotation.
+
+    // As the same way, there are 1 dummy block at the bottom as playground's bottom border,
+    // and 4 dummy blocks at the top (NUM_OF_BLOCK_FOR_PIECE_ENVELOPE) to detect "block overflow" (game-over)
+    block_status playground_block_buffer[1 + 20 + 4][2 + 10 + 2];
+    piece_info piece_active, piece_backup;
+    uint32_t random_state; // Xorshift32 state for piece generation
+} game_instance;
+
+// Rules of a single game instance, without any timing or key reading
+void init_game(game_instance *game, uint32_t seed);
+void start_game(game_instance *game, game_mode mode);
+bool drop_piece(game_instance *game);
+bool move_piece(game_instance *game, key_type key);
+// Score awarded for lines eliminated at once, before it is added to
+// the 16-bit status.score
+uint32_t get_award(uint16_t award_factor, unsigned char line_eliminated_once);
+
+// The game played on the device, driven by millis() and the keypad
 void reset_game(void);
 bool step_game(void);
 
-#endif
\ No newline at end of file
+#endif
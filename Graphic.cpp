@@ -117,31 +117,137 @@ void draw_score(long score) {
 // Use all 8 pages in a column (including border pixels)
 unsigned char playground_column_pixel_buffer[8];
 
-// Draw blocks in a certain layer
-void draw_playground_layer(unsigned char layer, block_status *block_status_layer) {
-    block_status block_type;
-    unsigned char block_id, left_pix_id;
-    unsigned int bit_pattern;
-    memset(playground_column_pixel_buffer, 0, 8);
-    playground_column_pixel_buffer[0] |= 0x01; // Re-draw (to keep) both border lines
-    playground_column_pixel_buffer[7] |= 0x80;
-    for(block_id = 0; block_id < 10; block_id++){
-        block_type = block_status_layer[block_id];
-        if(block_type == NO_BLOCK) continue;
-        else if(block_type == BLOCK_TO_CLEAN) continue;
-        // left boader line and the first gap take up 2 pixels
-        left_pix_id = 2 + block_id * 6;
-        bit_pattern = 0b111110 << (left_pix_id % 8);
-        playground_column_pixel_buffer[left_pix_id / 8] |= bit_pattern & 0xFF;
-        if((bit_pattern & ~0xFF) != 0)
-            playground_column_pixel_buffer[left_pix_id / 8 + 1] |= (bit_pattern & ~0xFF) >> 8;
+// Column bytes of a layer, indexed by half of the layer's block mask
+// (bit n set: block n is drawn, block 0 is the leftmost one)
+// Blocks 0-4 only cover pages 0-3 and blocks 5-9 only cover pages 4-7,
+// so the two halves never share a byte, and border lines are included
+// Line comments give the blocks of the half in order (blocks 0-4 or 5-9)
+const unsigned char playground_column_low_map[32][4] PROGMEM = {
+    {0x01, 0x00, 0x00, 0x00}, // 00000
+    {0xF9, 0x00, 0x00, 0x00}, // 10000
+    {0x01, 0x3E, 0x00, 0x00}, // 01000
+    {0xF9, 0x3E, 0x00, 0x00}, // 11000
+    {0x01, 0x80, 0x0F, 0x00}, // 00100
+    {0xF9, 0x80, 0x0F, 0x00}, // 10100
+    {0x01, 0xBE, 0x0F, 0x00}, // 01100
+    {0xF9, 0xBE, 0x0F, 0x00}, // 11100
+    {0x01, 0x00, 0xE0, 0x03}, // 00010
+    {0xF9, 0x00, 0xE0, 0x03}, // 10010
+    {0x01, 0x3E, 0xE0, 0x03}, // 01010
+    {0xF9, 0x3E, 0xE0, 0x03}, // 11010
+    {0x01, 0x80, 0xEF, 0x03}, // 00110
+    {0xF9, 0x80, 0xEF, 0x03}, // 10110
+    {0x01, 0xBE, 0xEF, 0x03}, // 01110
+    {0xF9, 0xBE, 0xEF, 0x03}, // 11110
+    {0x01, 0x00, 0x00, 0xF8}, // 00001
+    {0xF9, 0x00, 0x00, 0xF8}, // 10001
+    {0x01, 0x3E, 0x00, 0xF8}, // 01001
+    {0xF9, 0x3E, 0x00, 0xF8}, // 11001
+    {0x01, 0x80, 0x0F, 0xF8}, // 00101
+    {0xF9, 0x80, 0x0F, 0xF8}, // 10101
+    {0x01, 0xBE, 0x0F, 0xF8}, // 01101
+    {0xF9, 0xBE, 0x0F, 0xF8}, // 11101
+    {0x01, 0x00, 0xE0, 0xFB}, // 00011
+    {0xF9, 0x00, 0xE0, 0xFB}, // 10011
+    {0x01, 0x3E, 0xE0, 0xFB}, // 01011
+    {0xF9, 0x3E, 0xE0, 0xFB}, // 11011
+    {0x01, 0x80, 0xEF, 0xFB}, // 00111
+    {0xF9, 0x80, 0xEF, 0xFB}, // 10111
+    {0x01, 0xBE, 0xEF, 0xFB}, // 01111
+    {0xF9, 0xBE, 0xEF, 0xFB}  // 11111
+};
+
+const unsigned char playground_column_high_map[32][4] PROGMEM = {
+    {0x00, 0x00, 0x00, 0x80}, // 00000
+    {0x3E, 0x00, 0x00, 0x80}, // 10000
+    {0x80, 0x0F, 0x00, 0x80}, // 01000
+    {0xBE, 0x0F, 0x00, 0x80}, // 11000
+    {0x00, 0xE0, 0x03, 0x80}, // 00100
+    {0x3E, 0xE0, 0x03, 0x80}, // 10100
+    {0x80, 0xEF, 0x03, 0x80}, // 01100
+    {0xBE, 0xEF, 0x03, 0x80}, // 11100
+    {0x00, 0x00, 0xF8, 0x80}, // 00010
+    {0x3E, 0x00, 0xF8, 0x80}, // 10010
+    {0x80, 0x0F, 0xF8, 0x80}, // 01010
+    {0xBE, 0x0F, 0xF8, 0x80}, // 11010
+    {0x00, 0xE0, 0xFB, 0x80}, // 00110
+    {0x3E, 0xE0, 0xFB, 0x80}, // 10110
+    {0x80, 0xEF, 0xFB, 0x80}, // 01110
+    {0xBE, 0xEF, 0xFB, 0x80}, // 11110
+    {0x00, 0x00, 0x00, 0xBE}, // 00001
+    {0x3E, 0x00, 0x00, 0xBE}, // 10001
+    {0x80, 0x0F, 0x00, 0xBE}, // 01001
+    {0xBE, 0x0F, 0x00, 0xBE}, // 11001
+    {0x00, 0xE0, 0x03, 0xBE}, // 00101
+    {0x3E, 0xE0, 0x03, 0xBE}, // 10101
+    {0x80, 0xEF, 0x03, 0xBE}, // 01101
+    {0xBE, 0xEF, 0x03, 0xBE}, // 11101
+    {0x00, 0x00, 0xF8, 0xBE}, // 00011
+    {0x3E, 0x00, 0xF8, 0xBE}, // 10011
+    {0x80, 0x0F, 0xF8, 0xBE}, // 01011
+    {0xBE, 0x0F, 0xF8, 0xBE}, // 11011
+    {0x00, 0xE0, 0xFB, 0xBE}, // 00111
+    {0x3E, 0xE0, 0xFB, 0xBE}, // 10111
+    {0x80, 0xEF, 0xFB, 0xBE}, // 01111
+    {0xBE, 0xEF, 0xFB, 0xBE}  // 11111
+};
+
+// Build the column bytes of a layer from its block mask, instead of
+// shifting a block pattern into place block by block
+__attribute__((noinline)) void _build_playground_column(unsigned int block_mask) {
+    const unsigned char *low_ptr = &playground_column_low_map[block_mask & 0x1F][0];
+    const unsigned char *high_ptr = &playground_column_high_map[(block_mask >> 5) & 0x1F][0];
+    for (unsigned char page = 0; page < 4; page++) {
+        playground_column_pixel_buffer[page] = pgm_read_byte(low_ptr + page);
+        playground_column_pixel_buffer[page + 4] = pgm_read_byte(high_ptr + page);
     }
-    unsigned char column, page, bottom_column = layer * 6 + 1;
+}
+
+// Draw blocks in a certain layer
+void draw_playground_layer(unsigned char layer, unsigned int block_mask) {
+    _build_playground_column(block_mask);
+    unsigned char bottom_column = layer * 6 + 1;
     set_ptr_ssd1306(bottom_column, bottom_column + 4, 0, 7);
-    for (column = 0; column < 5; column++)
-        for (page = 0; page <= 7; page++)
-            send_data_byte_ssd1306(playground_column_pixel_buffer[page]);
+    // All the 5 columns of a layer are the same, send them in one burst
+    send_data_repeat_ssd1306(playground_column_pixel_buffer, 8, 5);
+}
+
+#ifdef BENCHMARK_PLAYGROUND_LAYER
+// Print on the serial port the CPU cycles (Timer1, no prescaler) taken
+// to build the column bytes, and the time to send the whole layer,
+// for an empty, a full and a mixed layer
+void benchmark_playground_layer(void) {
+    const unsigned int block_masks[3] = {0x000, 0x3FF, 0x2B5};
+    const char *layer_names[3] = {"empty", "full", "mixed"};
+    unsigned char tccr1a = TCCR1A, tccr1b = TCCR1B;
+    unsigned int overhead, cycles;
+    unsigned long send_time;
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);
+    noInterrupts();
+    TCNT1 = 0;
+    overhead = TCNT1;
+    interrupts();
+    for (unsigned char i = 0; i < 3; i++) {
+        noInterrupts();
+        TCNT1 = 0;
+        _build_playground_column(block_masks[i]);
+        cycles = TCNT1 - overhead;
+        interrupts();
+        send_time = micros();
+        draw_playground_layer(0, block_masks[i]);
+        send_time = micros() - send_time;
+        Serial.print(layer_names[i]);
+        Serial.print(" layer: ");
+        Serial.print(cycles);
+        Serial.print(" cycles to build, ");
+        Serial.print(send_time);
+        Serial.println(" us to draw");
+    }
+    TCCR1A = tccr1a;
+    TCCR1B = tccr1b;
 }
+#endif
 
 const unsigned char letter_pixel_map[26 + 2][8] PROGMEM = {
     {0x20, 0x50, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x00}, // 'A'
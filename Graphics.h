@@ -8,8 +8,15 @@ typedef enum {EASY, NORMAL, HARD} game_mode;
 void clear_screen(void);
 void draw_score(long score);
 void draw_next_piece_hint(piece_type next_piece_type);
-void draw_playground_layer(unsigned char layer, block_status *block_status_layer);
+void draw_playground_layer(unsigned char layer, unsigned int block_mask);
 void draw_menu(game_mode selection);
 void draw_game_over(void);
 
+// Uncomment to print, on the serial port at 9600 baud, the cycles taken to
+// build an empty, a full and a mixed playground layer at start-up
+// #define BENCHMARK_PLAYGROUND_LAYER
+#ifdef BENCHMARK_PLAYGROUND_LAYER
+void benchmark_playground_layer(void);
+#endif
+
 #endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Keypad.h"
+#include "Tracer.h"
 #include <Arduino.h>
 
 #define PIN_ANALOG_KEYS A0
@@ -46,12 +47,14 @@ key_type read_key(void){
     if(!is_wait_key){
         key_timing[key_pressed] = millis();
         is_wait_key = true;
+        TRACE_KEY_READ((key_type)key_pressed);
         return (key_type)key_pressed;
     }
     if(millis() > key_timing[key_pressed] + key_wait_interval) {
         is_wait_key = false;
         if(key_wait_interval >= DEC_WAIT_INTERVAL_STEP)
             key_wait_interval -= DEC_WAIT_INTERVAL_STEP;
+        TRACE_KEY_READ((key_type)key_pressed);
         return (key_type)key_pressed;
     }
     return NO_KEY;
@@ -1,6 +1,9 @@
 #include <Wire.h>
+#include "Tracer.h"
 
 #define I2C_SPEED 400000
+// Wire's transmit buffer holds BUFFER_LENGTH bytes, control byte included
+#define I2C_MAX_DATA_PER_TRANSMISSION (BUFFER_LENGTH - 1)
 
 // Address Byte: 0111 10(SA0)(R/W#)
 // I2C Slave Address: 011110 (b7-b2), fixed for SSD1306
@@ -76,4 +79,33 @@ void send_data_byte_ssd1306(unsigned char data) {
     Wire.write(SSD1306_CTRL_BYTE_DATA);
     Wire.write(data);
     Wire.endTransmission();
+    TRACE_I2C_SENT();
+}
+
+// Send (length * repeat) data bytes with as few transmissions as possible,
+// i.e. one control byte (Co = 0, all following bytes are data) for each
+// full transmit buffer, instead of one transmission for each byte
+void send_data_repeat_ssd1306(const unsigned char *data, unsigned char length,
+                              unsigned char repeat) {
+    unsigned char data_idx = 0, data_cnt = 0;
+    if (length == 0 || repeat == 0) return;
+    Wire.beginTransmission(SSD1306_I2C_ADDR_BYTE);
+    Wire.write(SSD1306_CTRL_BYTE_DATA);
+    while (repeat > 0) {
+        if (data_cnt == I2C_MAX_DATA_PER_TRANSMISSION) {
+            Wire.endTransmission();
+            TRACE_I2C_SENT();
+            Wire.beginTransmission(SSD1306_I2C_ADDR_BYTE);
+            Wire.write(SSD1306_CTRL_BYTE_DATA);
+            data_cnt = 0;
+        }
+        Wire.write(data[data_idx]);
+        data_cnt++;
+        if (++data_idx == length) {
+            data_idx = 0;
+            repeat--;
+        }
+    }
+    Wire.endTransmission();
+    TRACE_I2C_SENT();
 }
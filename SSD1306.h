@@ -7,5 +7,7 @@ void set_ptr_ssd1306(unsigned char col_s, unsigned char col_e,
                      unsigned char page_s, unsigned char page_e);
 
 void send_data_byte_ssd1306(unsigned char data);
+void send_data_repeat_ssd1306(const unsigned char *data, unsigned char length,
+                              unsigned char repeat);
 
 #endif
\ No newline at end of file
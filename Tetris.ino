@@ -1,16 +1,52 @@
 #include <Arduino.h>
 #include "SSD1306.h"
 #include "Game.h"
+#include "Tracer.h"
 
 #define PIN_SEED_NOISE 7
 
 void setup() {
     init_ssd1306();
+#ifdef BENCHMARK_PLAYGROUND_LAYER
+    Serial.begin(9600);
+    benchmark_playground_layer();
+#endif
+#ifdef LATENCY_TRACER
+    Serial.begin(9600);
+    init_tracer();
+#endif
     randomSeed(analogRead(PIN_SEED_NOISE));
 }
 
+#ifdef LATENCY_TRACER
+void print_latency_report(void) {
+    const char *key_names[NO_KEY] = {"LEFT", "RIGHT", "DOWN", "ROTATE"};
+    latency_stats stats;
+    for (unsigned char key = KEY_LEFT; key < NO_KEY; key++) {
+        get_latency_stats((key_type)key, &stats);
+        Serial.print(key_names[key]);
+        Serial.print(": traced ");
+        Serial.print(stats.traced);
+        Serial.print(", no frame ");
+        Serial.print(stats.no_frame);
+        Serial.print(", lost ");
+        Serial.print(stats.lost);
+        Serial.print(", p50/p99/max ");
+        Serial.print(stats.p50);
+        Serial.print("/");
+        Serial.print(stats.p99);
+        Serial.print("/");
+        Serial.print(stats.max);
+        Serial.println(" us");
+    }
+}
+#endif
+
 void loop() {
     reset_game();
     while(step_game());
+#ifdef LATENCY_TRACER
+    print_latency_report();
+#endif
     while(1);
 }
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <Arduino.h>
+#include "Tracer.h"
+
+#ifdef LATENCY_TRACER
+
+// Latencies are kept in a log-linear histogram to save RAM: below
+// 2 ^ LATENCY_SUB_BUCKET_BITS units every unit has its own bucket, and
+// every octave above is split into 2 ^ LATENCY_SUB_BUCKET_BITS buckets
+// (at most 25% wide by default). The percentiles are the upper bound of
+// their bucket, and the last bucket also holds anything longer.
+// The host build overrides these to get 1 us buckets, i.e. exact values
+#ifndef LATENCY_UNIT
+#define LATENCY_UNIT 64 // Unit: microsecond
+#endif
+#ifndef LATENCY_SUB_BUCKET_BITS
+#define LATENCY_SUB_BUCKET_BITS 2
+#endif
+#ifndef LATENCY_NUM_OF_OCTAVES
+#define LATENCY_NUM_OF_OCTAVES 9 // Up to 2 ^ (2 + 9) units, i.e. 131 ms
+#endif
+// Buckets count in 8 bits: when one is full, every bucket of the key is
+// halved. The percentiles only depend on the proportions, so they hold
+#ifndef LATENCY_BUCKET_TYPE
+#define LATENCY_BUCKET_TYPE uint8_t
+#endif
+#define LATENCY_SUB_BUCKETS (1UL << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_NUM_OF_BUCKETS ((LATENCY_NUM_OF_OCTAVES + 1) * LATENCY_SUB_BUCKETS)
+
+static struct {
+    LATENCY_BUCKET_TYPE histogram[LATENCY_NUM_OF_BUCKETS];
+    unsigned int traced, no_frame, lost;
+    unsigned long max;
+} key_latency[NO_KEY];
+
+// Key event being followed, NO_KEY if none
+static key_type key_traced = NO_KEY;
+static unsigned long key_time, last_sent_time;
+static bool is_frame_sent;
+
+static unsigned long _get_bucket(unsigned long latency) {
+    unsigned long units = latency / LATENCY_UNIT;
+    unsigned char shift = 0;
+    if (units < LATENCY_SUB_BUCKETS) return units;
+    // Keep the (LATENCY_SUB_BUCKET_BITS + 1) most significant bits
+    while ((units >> shift) >= 2 * LATENCY_SUB_BUCKETS) shift++;
+    if (shift >= LATENCY_NUM_OF_OCTAVES) return LATENCY_NUM_OF_BUCKETS - 1;
+    return (shift + 1) * LATENCY_SUB_BUCKETS + ((units >> shift) - LATENCY_SUB_BUCKETS);
+}
+
+// Largest latency (in microsecond) that falls into the bucket
+static unsigned long _get_bucket_bound(unsigned long bucket) {
+    unsigned char shift;
+    if (bucket < LATENCY_SUB_BUCKETS) return (bucket + 1) * LATENCY_UNIT - 1;
+    shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    return ((bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS + 1) << shift) * LATENCY_UNIT - 1;
+}
+
+static void _count_latency(key_type key, unsigned long bucket) {
+    LATENCY_BUCKET_TYPE *histogram = key_latency[key].histogram;
+    if ((LATENCY_BUCKET_TYPE)(histogram[bucket] + 1) == 0) {
+        // Rounded up, so that no latency seen ever drops out
+        for (unsigned long i = 0; i < LATENCY_NUM_OF_BUCKETS; i++)
+            histogram[i] = (histogram[i] + 1) / 2;
+    }
+    histogram[bucket]++;
+}
+
+void init_tracer(void) {
+    pinMode(PIN_TRACE, OUTPUT);
+    digitalWrite(PIN_TRACE, LOW);
+    memset(key_latency, 0, sizeof(key_latency));
+    key_traced = NO_KEY;
+}
+
+void trace_key_read(key_type key) {
+    key_time = micros();
+    digitalWrite(PIN_TRACE, HIGH);
+    key_traced = key;
+    is_frame_sent = false;
+}
+
+// Wire's endTransmission() only returns once every byte is on the bus
+void trace_i2c_sent(void) {
+    if (key_traced == NO_KEY) return;
+    last_sent_time = micros();
+    is_frame_sent = true;
+}
+
+void trace_key_done(void) {
+    unsigned long latency;
+    if (key_traced == NO_KEY) return;
+    digitalWrite(PIN_TRACE, LOW);
+    if (is_frame_sent) {
+        latency = last_sent_time - key_time;
+        _count_latency(key_traced, _get_bucket(latency));
+        key_latency[key_traced].traced++;
+        if (latency > key_latency[key_traced].max)
+            key_latency[key_traced].max = latency;
+    } else key_latency[key_traced].no_frame++;
+    key_traced = NO_KEY;
+}
+
+void trace_key_lost(void) {
+    if (key_traced == NO_KEY) return;
+    digitalWrite(PIN_TRACE, LOW);
+    key_latency[key_traced].lost++;
+    key_traced = NO_KEY;
+}
+
+// Key events outside of the game (e.g. in the menu) are not traced
+void trace_key_cancel(void) {
+    if (key_traced == NO_KEY) return;
+    digitalWrite(PIN_TRACE, LOW);
+    key_traced = NO_KEY;
+}
+
+// Ranked within the histogram itself, which may have been halved
+static unsigned long _get_percentile(key_type key, unsigned char percent) {
+    unsigned long rank, count = 0, bucket;
+    for (bucket = 0; bucket < LATENCY_NUM_OF_BUCKETS; bucket++)
+        count += key_latency[key].histogram[bucket];
+    rank = (count * percent + 99) / 100;
+    count = 0;
+    for (bucket = 0; bucket < LATENCY_NUM_OF_BUCKETS - 1; bucket++) {
+        count += key_latency[key].histogram[bucket];
+        if (count >= rank) break;
+    }
+    if (bucket == LATENCY_NUM_OF_BUCKETS - 1) return key_latency[key].max;
+    return _get_bucket_bound(bucket);
+}
+
+void get_latency_stats(key_type key, latency_stats *stats) {
+    stats->traced = key_latency[key].traced;
+    stats->no_frame = key_latency[key].no_frame;
+    stats->lost = key_latency[key].lost;
+    stats->max = key_latency[key].max;
+    if (stats->traced == 0) {
+        stats->p50 = stats->p99 = 0;
+        return;
+    }
+    stats->p50 = _get_percentile(key, 50);
+    stats->p99 = _get_percentile(key, 99);
+    // A bucket upper bound may exceed the slowest event actually seen
+    if (stats->p50 > stats->max) stats->p50 = stats->max;
+    if (stats->p99 > stats->max) stats->p99 = stats->max;
+}
+
+unsigned long get_num_of_key_events(void) {
+    unsigned long num_of_events = 0;
+    for (unsigned char key = 0; key < NO_KEY; key++) {
+        num_of_events += key_latency[key].traced;
+        num_of_events += key_latency[key].no_frame;
+        num_of_events += key_latency[key].lost;
+    }
+    return num_of_events;
+}
+
+#endif
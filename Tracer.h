@@ -0,0 +1,48 @@
+#ifndef _TRACER_H_
+#define _TRACER_H_
+
+#include "Keypad.h"
+
+// Uncomment to trace the latency from a key event (read_key) to the last
+// display byte of the frame it causes leaving the I2C transport
+// #define LATENCY_TRACER
+
+#ifdef LATENCY_TRACER
+
+// High from the key event until the last display byte is sent
+#define PIN_TRACE 8
+
+typedef struct {
+    unsigned int traced;   // Key events followed by a frame
+    unsigned int no_frame; // Key events that drew nothing (e.g. blocked)
+    unsigned int lost;     // Key events skipped, gravity went first
+    unsigned long p50, p99, max; // Unit: microsecond
+} latency_stats;
+
+void init_tracer(void);
+void trace_key_read(key_type key);
+void trace_i2c_sent(void);
+void trace_key_done(void);
+void trace_key_lost(void);
+void trace_key_cancel(void);
+void get_latency_stats(key_type key, latency_stats *stats);
+// Key events of every key so far, traced or not (cheap, unlike the stats)
+unsigned long get_num_of_key_events(void);
+
+#define TRACE_KEY_READ(key) trace_key_read(key)
+#define TRACE_I2C_SENT() trace_i2c_sent()
+#define TRACE_KEY_DONE() trace_key_done()
+#define TRACE_KEY_LOST() trace_key_lost()
+#define TRACE_KEY_CANCEL() trace_key_cancel()
+
+#else
+
+#define TRACE_KEY_READ(key)
+#define TRACE_I2C_SENT()
+#define TRACE_KEY_DONE()
+#define TRACE_KEY_LOST()
+#define TRACE_KEY_CANCEL()
+
+#endif
+
+#endif
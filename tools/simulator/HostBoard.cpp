@@ -0,0 +1,93 @@
+// Simulated board for the host build of the whole sketch: a clock that
+// only moves when the hardware would keep the CPU busy (ADC conversions
+// and I2C transfers), the analog keypad, and an I2C bus model
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "HostBoard.h"
+
+// Arduino AVR: 13 ADC clocks at 125 kHz (16 MHz / 128)
+#define ADC_CONVERSION_TIME 104000 // Unit: nanosecond
+
+// Middle of the voltage ranges read_key() accepts, and nothing pressed
+static const int key_voltage[NO_KEY + 1] = {2, 505, 327, 740, 1023};
+
+static unsigned long long now; // Unit: nanosecond
+static long random_state = 1;  // avr-libc's initial seed
+static key_type key_pressed = NO_KEY;
+
+static unsigned long i2c_clock = 100000; // Wire's default
+static unsigned char i2c_buffer_length;
+static unsigned long i2c_bytes_sent, i2c_bytes_dropped;
+
+TwoWire Wire;
+
+unsigned long millis(void) { return now / 1000000; }
+unsigned long micros(void) { return now / 1000; }
+
+// Same generator as avr-libc's random() (Park-Miller minimal standard),
+// reset_game() seeds every new game with it, as on the board
+static long _random(void) {
+    long hi = random_state / 127773, lo = random_state % 127773;
+    random_state = 16807 * lo - 2836 * hi;
+    if (random_state < 0) random_state += 0x7FFFFFFFL;
+    return random_state;
+}
+
+long random(long howbig) {
+    if (howbig == 0) return 0;
+    return _random() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+// As Arduino's randomSeed(), which ignores a zero seed
+void randomSeed(unsigned long seed) {
+    if (seed != 0) random_state = seed % 0x7FFFFFFFL;
+    if (random_state == 0) random_state = 123459876L;
+}
+
+int analogRead(unsigned char pin) {
+    (void)pin;
+    now += ADC_CONVERSION_TIME;
+    return key_voltage[key_pressed];
+}
+
+void pinMode(unsigned char pin, unsigned char mode) { (void)pin; (void)mode; }
+void digitalWrite(unsigned char pin, unsigned char value) { (void)pin; (void)value; }
+
+void TwoWire::begin(void) {}
+
+void TwoWire::setClock(unsigned long clock) { i2c_clock = clock; }
+
+void TwoWire::beginTransmission(unsigned char address) {
+    (void)address;
+    i2c_buffer_length = 0;
+}
+
+size_t TwoWire::write(unsigned char data) {
+    (void)data;
+    if (i2c_buffer_length >= BUFFER_LENGTH) {
+        i2c_bytes_dropped++;
+        return 0;
+    }
+    i2c_buffer_length++;
+    return 1;
+}
+
+// START, address byte and buffered bytes (8 bits + ACK each), STOP
+unsigned char TwoWire::endTransmission(void) {
+    unsigned long bits = 1 + 9 * (1 + i2c_buffer_length) + 1;
+    now += (unsigned long long)bits * 1000000000ULL / i2c_clock;
+    i2c_bytes_sent += i2c_buffer_length;
+    i2c_buffer_length = 0;
+    return 0;
+}
+
+void host_press_key(key_type key) { key_pressed = key; }
+unsigned long long host_time_ns(void) { return now; }
+unsigned long host_i2c_bytes_sent(void) { return i2c_bytes_sent; }
+unsigned long host_i2c_bytes_dropped(void) { return i2c_bytes_dropped; }
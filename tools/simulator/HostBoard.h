@@ -0,0 +1,13 @@
+#ifndef _HOST_BOARD_H_
+#define _HOST_BOARD_H_
+
+#include "Keypad.h"
+
+// Key held on the analog keypad from now on (NO_KEY: released)
+void host_press_key(key_type key);
+unsigned long long host_time_ns(void);
+unsigned long host_i2c_bytes_sent(void);
+// Bytes Wire refused because its transmit buffer was full
+unsigned long host_i2c_bytes_dropped(void);
+
+#endif
@@ -0,0 +1,25 @@
+// Headless replacements of the display, keypad and timing functions
+// the game rules call into. Every stub is stateless, so games running
+// in different threads never share anything through them.
+
+#include <Arduino.h>
+#include "Graphics.h"
+#include "Keypad.h"
+
+unsigned long millis(void) { return 0; }
+// Games are seeded explicitly through init_game(), nothing is left to chance here
+long random(long howbig) { (void)howbig; return 0; }
+long random(long howsmall, long howbig) { (void)howbig; return howsmall; }
+
+void clear_screen(void) {}
+void draw_score(long score) { (void)score; }
+void draw_next_piece_hint(piece_type next_piece_type) { (void)next_piece_type; }
+void draw_playground_layer(unsigned char layer, unsigned int block_mask) {
+    (void)layer;
+    (void)block_mask;
+}
+void draw_menu(game_mode selection) { (void)selection; }
+void draw_game_over(void) {}
+
+key_type read_key(void) { return NO_KEY; }
+void reset_key_state(void) {}
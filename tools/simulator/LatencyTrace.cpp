@@ -0,0 +1,166 @@
+// Input-to-pixel latency of the whole sketch on a modeled board
+//
+// Builds the real game, graphics, keypad and SSD1306 sources with the
+// latency tracer enabled, on top of HostBoard.cpp (400 kHz I2C model,
+// ADC conversion time). A scripted player taps keys in a seeded random
+// order, restarting the game on game over, until enough key events were
+// traced, then the per key p50/p99/max latency is printed. The seed sets
+// both the key script and, through randomSeed(), the games' pieces.
+//
+// The time the CPU spends running the sketch code itself is not modeled,
+// only the time it waits for the ADC and the I2C bus.
+//
+// Usage: latency [-e events] [-s seed] [-t hold_ms] [-g gap_ms]
+//                [-m max_p50_us[,...]] [-l max_p99_us[,...]]
+//   -m, -l: exit with failure if a key's p50 (p99) latency exceeds its
+//           limit, so that latency regressions fail "make check". Either
+//           one limit for every key, or one per key in the order
+//           LEFT,RIGHT,DOWN,ROTATE (0: no limit)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <Arduino.h>
+#include "Game.h"
+#include "SSD1306.h"
+#include "Tracer.h"
+#include "HostBoard.h"
+
+typedef struct {
+    unsigned long num_of_events;
+    unsigned long seed;
+    unsigned long hold_time; // Unit: millisecond
+    unsigned long gap_time;  // Unit: millisecond
+    unsigned long max_p50[NO_KEY]; // Unit: microsecond, 0 for no limit
+    unsigned long max_p99[NO_KEY]; // Unit: microsecond, 0 for no limit
+    bool is_limited;
+} trace_config;
+
+// Tap one key, then release it, for as long as the game goes on
+static void _play_games(const trace_config *config) {
+    unsigned long random_state = config->seed ? config->seed : 1;
+    unsigned long long key_change = 0;
+    bool is_pressed = false, is_alive = false;
+    while (get_num_of_key_events() < config->num_of_events) {
+        if (!is_alive) {
+            reset_game();
+            // Release any key held at game over, then start from the menu
+            host_press_key(NO_KEY);
+            step_game();
+            host_press_key(KEY_ROTATE);
+            key_change = host_time_ns() + config->hold_time * 1000000ULL;
+            while (host_time_ns() < key_change)
+                step_game();
+            host_press_key(NO_KEY);
+            is_pressed = false;
+            key_change = host_time_ns() + config->gap_time * 1000000ULL;
+            is_alive = true;
+        }
+        while (is_alive && host_time_ns() < key_change)
+            is_alive = step_game();
+        if (!is_alive) continue;
+        if (is_pressed) {
+            host_press_key(NO_KEY);
+            key_change = host_time_ns() + config->gap_time * 1000000ULL;
+        } else {
+            random_state ^= random_state << 13;
+            random_state ^= random_state >> 7;
+            random_state ^= random_state << 17;
+            host_press_key((key_type)(random_state % NO_KEY));
+            key_change = host_time_ns() + config->hold_time * 1000000ULL;
+        }
+        is_pressed = !is_pressed;
+    }
+}
+
+static bool _print_report(const trace_config *config) {
+    const char *key_names[NO_KEY] = {"LEFT", "RIGHT", "DOWN", "ROTATE"};
+    latency_stats stats;
+    bool is_passed = true;
+    printf("key events: %lu  seed: %lu  hold: %lu ms  gap: %lu ms  simulated: %.1f s\n",
+           get_num_of_key_events(), config->seed, config->hold_time, config->gap_time,
+           host_time_ns() / 1e9);
+    printf("%-8s %8s %8s %8s %10s %10s %10s\n",
+           "key", "traced", "no frame", "lost", "p50(us)", "p99(us)", "max(us)");
+    for (unsigned char key = KEY_LEFT; key < NO_KEY; key++) {
+        get_latency_stats((key_type)key, &stats);
+        bool is_over = false;
+        if (config->max_p50[key] != 0 && stats.p50 > config->max_p50[key]) is_over = true;
+        if (config->max_p99[key] != 0 && stats.p99 > config->max_p99[key]) is_over = true;
+        printf("%-8s %8u %8u %8u %10lu %10lu %10lu%s\n", key_names[key],
+               stats.traced, stats.no_frame, stats.lost, stats.p50, stats.p99, stats.max,
+               is_over ? "  over limit" : "");
+        if (is_over) is_passed = false;
+    }
+    printf("I2C: %lu bytes sent, %lu bytes dropped by a full transmit buffer\n",
+           host_i2c_bytes_sent(), host_i2c_bytes_dropped());
+    if (host_i2c_bytes_dropped() != 0) is_passed = false;
+    if (config->is_limited) {
+        printf("p50/p99 limits (us):");
+        for (unsigned char key = KEY_LEFT; key < NO_KEY; key++)
+            printf(" %s %lu/%lu", key_names[key], config->max_p50[key], config->max_p99[key]);
+        printf(": %s\n", is_passed ? "passed" : "FAILED");
+    }
+    return is_passed;
+}
+
+static void _usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-e events] [-s seed] [-t hold_ms] [-g gap_ms]\n"
+                    "       [-m max_p50_us[,...]] [-l max_p99_us[,...]]\n", program);
+    exit(EXIT_FAILURE);
+}
+
+// One limit for every key, or NO_KEY comma separated ones
+static bool _parse_limits(const char *arg, unsigned long limits[NO_KEY]) {
+    unsigned char num_of_limits = 0;
+    char *end;
+    do {
+        if (num_of_limits == NO_KEY) return false;
+        limits[num_of_limits++] = strtoul(arg, &end, 0);
+        if (end == arg) return false;
+        arg = end + 1;
+    } while (*end == ',');
+    if (*end != '\0') return false;
+    if (num_of_limits == 1)
+        for (unsigned char key = 1; key < NO_KEY; key++) limits[key] = limits[0];
+    else if (num_of_limits != NO_KEY) return false;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    trace_config config;
+    config.num_of_events = 1000;
+    config.seed = 1;
+    config.hold_time = 40;
+    config.gap_time = 150;
+    memset(config.max_p50, 0, sizeof(config.max_p50));
+    memset(config.max_p99, 0, sizeof(config.max_p99));
+    config.is_limited = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:s:t:g:m:l:")) != -1) {
+        switch (opt) {
+        case 'e': config.num_of_events = strtoul(optarg, NULL, 0); break;
+        case 's': config.seed = strtoul(optarg, NULL, 0); break;
+        case 't': config.hold_time = strtoul(optarg, NULL, 0); break;
+        case 'g': config.gap_time = strtoul(optarg, NULL, 0); break;
+        case 'm':
+            if (!_parse_limits(optarg, config.max_p50)) _usage(argv[0]);
+            config.is_limited = true;
+            break;
+        case 'l':
+            if (!_parse_limits(optarg, config.max_p99)) _usage(argv[0]);
+            config.is_limited = true;
+            break;
+        default: _usage(argv[0]);
+        }
+    }
+    if (config.hold_time == 0 || config.gap_time == 0) _usage(argv[0]);
+
+    init_ssd1306();
+    init_tracer();
+    randomSeed(config.seed);
+    _play_games(&config);
+    return _print_report(&config) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
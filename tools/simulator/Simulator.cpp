@@ -0,0 +1,276 @@
+// Batch game simulator for tuning gravity and scoring on a Linux host
+//
+// Plays N seeded games in parallel (one game per task, tasks spread over
+// all the worker threads) with a heuristic player, then prints aggregate
+// statistics. Game i is always seeded with (seed + i), so the result of a
+// batch only depends on its options, never on the number of threads.
+//
+// Time is simulated: gravity fires every drop_interval milliseconds
+// (as step_game() does with millis()), and the player may press one key
+// every key interval milliseconds.
+//
+// status.score is 16-bit, as on the device, and wraps around in long
+// games, so the score reported here is summed up from every award instead
+// (the games whose device score wrapped are counted apart).
+//
+// Usage: simulator [-n games] [-j threads] [-s seed] [-m easy|normal|hard]
+//                  [-k key_interval_ms] [-p max_pieces] [-g]
+//   -g: never press KEY_DOWN, let gravity land every piece
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "Game.h"
+
+typedef struct {
+    unsigned long num_of_games;
+    unsigned int num_of_threads;
+    unsigned long seed;
+    game_mode mode;
+    unsigned long key_interval; // Unit: millisecond
+    unsigned int max_pieces;
+    bool is_soft_drop;
+} sim_config;
+
+typedef struct {
+    unsigned long long score; // Never wraps, unlike status.score
+    bool is_score_wrapped;    // status.score went past 65535
+    unsigned int line_eliminated;
+    unsigned int piece_landed;
+    unsigned long duration; // Unit: millisecond (simulated)
+    bool is_capped;         // Stopped by max_pieces instead of game over
+} game_result;
+
+// Weights of the board evaluation (aggregate height, lines, holes, bumpiness)
+#define WEIGHT_HEIGHT    -0.510066
+#define WEIGHT_LINES      0.760666
+#define WEIGHT_HOLES     -0.35663
+#define WEIGHT_BUMPINESS -0.184483
+
+// Only the landed part counts, the freshly loaded piece is BLOCK_TO_DRAW
+static double _evaluate_playground(const game_instance *game, unsigned int lines) {
+    unsigned char column_height[10];
+    unsigned int aggregate_height = 0, holes = 0, bumpiness = 0;
+    unsigned char x, y;
+    for (x = 0; x < 10; x++) {
+        column_height[x] = 0;
+        for (y = 20; y >= 1; y--) {
+            if (game->playground_block_buffer[y][x + 2] != BLOCK_INACTIVE) continue;
+            if (column_height[x] == 0) column_height[x] = y;
+        }
+        for (y = 1; y < column_height[x]; y++)
+            if (game->playground_block_buffer[y][x + 2] != BLOCK_INACTIVE) holes++;
+        aggregate_height += column_height[x];
+        if (x > 0) bumpiness += abs(column_height[x] - column_height[x - 1]);
+    }
+    return WEIGHT_HEIGHT * aggregate_height + WEIGHT_LINES * lines +
+           WEIGHT_HOLES * holes + WEIGHT_BUMPINESS * bumpiness;
+}
+
+// Key sequence (rotations, then shifts) that positions the active piece
+typedef struct {
+    key_type keys[4 + 5];
+    unsigned char num_of_keys;
+} piece_plan;
+
+static void _make_plan(piece_plan *plan, unsigned char rotation, int shift) {
+    plan->num_of_keys = 0;
+    while (rotation-- > 0) plan->keys[plan->num_of_keys++] = KEY_ROTATE;
+    for (; shift < 0; shift++) plan->keys[plan->num_of_keys++] = KEY_LEFT;
+    for (; shift > 0; shift--) plan->keys[plan->num_of_keys++] = KEY_RIGHT;
+}
+
+// Try every rotation and shift on a copy of the game, drop the piece
+// down and keep the placement whose resulting playground scores best.
+// A blocked rotation simply leaves the piece as it is, the same way
+// it would in the real game, so every plan is a legal one.
+static void _plan_piece(const game_instance *game, piece_plan *best_plan) {
+    double best_value = 0;
+    bool is_first = true;
+    piece_plan plan;
+    game_instance trial;
+    for (unsigned char rotation = 0; rotation < 4; rotation++) {
+        for (int shift = -5; shift <= 5; shift++) {
+            _make_plan(&plan, rotation, shift);
+            trial = *game;
+            for (unsigned char i = 0; i < plan.num_of_keys; i++)
+                move_piece(&trial, plan.keys[i]);
+            // Shifted into a wall: same placement as a shorter shift
+            if (trial.piece_active.pos_x != game->piece_active.pos_x + shift) continue;
+            unsigned int piece_landed = trial.status.piece_landed;
+            bool is_alive = true;
+            while (is_alive && trial.status.piece_landed == piece_landed)
+                is_alive = drop_piece(&trial);
+            double value = -1e9; // Topping out is the worst choice
+            if (is_alive)
+                value = _evaluate_playground(&trial,
+                    (uint16_t)(trial.status.line_eliminated - game->status.line_eliminated));
+            if (is_first || value > best_value) {
+                best_value = value;
+                *best_plan = plan;
+                is_first = false;
+            }
+        }
+    }
+}
+
+static void _play_game(const sim_config *config, unsigned long seed, game_result *result) {
+    const unsigned long never = (unsigned long)-1;
+    game_instance game;
+    piece_plan plan = {{NO_KEY}, 0};
+    unsigned char plan_idx = 0;
+    unsigned int planned_piece = (unsigned int)-1;
+    unsigned long now = 0, next_drop, next_key;
+    unsigned long long score = 0;
+    uint16_t award_factor, line_eliminated;
+    bool is_alive = true;
+
+    init_game(&game, seed);
+    start_game(&game, config->mode);
+    // step_game() drops only after strictly more than drop_interval passed
+    next_drop = game.status.drop_interval + 1;
+    next_key = config->key_interval;
+    while (is_alive && game.status.piece_landed < config->max_pieces) {
+        if (game.status.piece_landed != planned_piece) {
+            // New piece on the playground, think while gravity goes on
+            _plan_piece(&game, &plan);
+            plan_idx = 0;
+            planned_piece = game.status.piece_landed;
+            next_key = now + config->key_interval;
+        }
+        // Award of the lines (if any) the key or gravity below eliminates
+        award_factor = game.status.award_factor;
+        line_eliminated = game.status.line_eliminated;
+        if (next_key < next_drop) {
+            now = next_key;
+            if (plan_idx < plan.num_of_keys) {
+                is_alive = move_piece(&game, plan.keys[plan_idx++]);
+                next_key = now + config->key_interval;
+            } else if (config->is_soft_drop) {
+                is_alive = move_piece(&game, KEY_DOWN);
+                next_key = now + config->key_interval;
+            } else next_key = never;
+        } else {
+            now = next_drop;
+            is_alive = drop_piece(&game);
+            next_drop = now + game.status.drop_interval + 1;
+        }
+        score += get_award(award_factor, (uint16_t)(game.status.line_eliminated - line_eliminated));
+    }
+    result->score = score;
+    result->is_score_wrapped = (score > 0xFFFF);
+    result->line_eliminated = game.status.line_eliminated;
+    result->piece_landed = game.status.piece_landed;
+    result->duration = now;
+    result->is_capped = is_alive;
+}
+
+// Every game writes only its own slot in results, so the only thing
+// the workers share is the counter handing out the next game to play
+static void _run_worker(const sim_config *config, std::atomic<unsigned long> *next_game,
+                        std::vector<game_result> *results) {
+    unsigned long game_idx;
+    while ((game_idx = next_game->fetch_add(1)) < config->num_of_games)
+        _play_game(config, config->seed + game_idx, &(*results)[game_idx]);
+}
+
+template <typename T>
+static void _print_distribution(const char *name, std::vector<T> values, double scale) {
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (size_t i = 0; i < values.size(); i++) sum += values[i];
+    size_t n = values.size();
+    printf("%-10s %12.1f %10.1f %10.1f %10.1f %10.1f %10.1f %12.1f\n", name,
+           sum / n / scale, values[0] / scale,
+           values[n / 10] / scale, values[n / 2] / scale,
+           values[n * 9 / 10] / scale, values[n * 99 / 100] / scale,
+           values[n - 1] / scale);
+}
+
+static void _print_report(const sim_config *config, const std::vector<game_result> &results,
+                          double wall_time) {
+    std::vector<unsigned long long> score;
+    std::vector<unsigned long> duration;
+    std::vector<unsigned int> lines, pieces;
+    unsigned long num_of_capped = 0, num_of_wrapped = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        score.push_back(results[i].score);
+        lines.push_back(results[i].line_eliminated);
+        pieces.push_back(results[i].piece_landed);
+        duration.push_back(results[i].duration);
+        if (results[i].is_capped) num_of_capped++;
+        if (results[i].is_score_wrapped) num_of_wrapped++;
+    }
+    printf("games: %lu  threads: %u  seed: %lu  mode: %d  key interval: %lu ms  soft drop: %s\n",
+           config->num_of_games, config->num_of_threads, config->seed, config->mode,
+           config->key_interval, config->is_soft_drop ? "on" : "off");
+    printf("%-10s %12s %10s %10s %10s %10s %10s %12s\n",
+           "", "mean", "min", "p10", "p50", "p90", "p99", "max");
+    _print_distribution("score", score, 1);
+    _print_distribution("lines", lines, 1);
+    _print_distribution("pieces", pieces, 1);
+    _print_distribution("length(s)", duration, 1000);
+    printf("capped at %u pieces: %lu game(s)\n", config->max_pieces, num_of_capped);
+    printf("16-bit score wrapped: %lu game(s)\n", num_of_wrapped);
+    printf("wall time: %.3f s  (%.1f games/s)\n", wall_time, config->num_of_games / wall_time);
+}
+
+static void _usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-n games] [-j threads] [-s seed] [-m easy|normal|hard]\n"
+                    "       [-k key_interval_ms] [-p max_pieces] [-g]\n", program);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+    sim_config config;
+    config.num_of_games = 1000;
+    config.num_of_threads = std::thread::hardware_concurrency();
+    if (config.num_of_threads == 0) config.num_of_threads = 1;
+    config.seed = 1;
+    config.mode = EASY;
+    config.key_interval = 100;
+    config.max_pieces = 10000;
+    config.is_soft_drop = true;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:j:s:m:k:p:g")) != -1) {
+        switch (opt) {
+        case 'n': config.num_of_games = strtoul(optarg, NULL, 0); break;
+        case 'j': config.num_of_threads = strtoul(optarg, NULL, 0); break;
+        case 's': config.seed = strtoul(optarg, NULL, 0); break;
+        case 'm':
+            if (strcmp(optarg, "easy") == 0) config.mode = EASY;
+            else if (strcmp(optarg, "normal") == 0) config.mode = NORMAL;
+            else if (strcmp(optarg, "hard") == 0) config.mode = HARD;
+            else _usage(argv[0]);
+            break;
+        case 'k': config.key_interval = strtoul(optarg, NULL, 0); break;
+        case 'p': config.max_pieces = strtoul(optarg, NULL, 0); break;
+        case 'g': config.is_soft_drop = false; break;
+        default: _usage(argv[0]);
+        }
+    }
+    if (config.num_of_games == 0 || config.num_of_threads == 0 || config.key_interval == 0)
+        _usage(argv[0]);
+    // piece_landed is 16-bit, as on the device
+    if (config.max_pieces == 0 || config.max_pieces > 0xFFFF) _usage(argv[0]);
+
+    std::vector<game_result> results(config.num_of_games);
+    std::atomic<unsigned long> next_game(0);
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < config.num_of_threads; i++)
+        workers.push_back(std::thread(_run_worker, &config, &next_game, &results));
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
+    _print_report(&config, results, wall_time.count());
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+// Minimal stand-in for the Arduino core, just enough to
+// build the sketch sources for a Linux host
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Flash is ordinary memory on the host
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+
+#define LOW 0
+#define HIGH 1
+#define OUTPUT 1
+#define A0 14
+
+unsigned long millis(void);
+unsigned long micros(void);
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+int analogRead(unsigned char pin);
+void pinMode(unsigned char pin, unsigned char mode);
+void digitalWrite(unsigned char pin, unsigned char value);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef _HOST_WIRE_H_
+#define _HOST_WIRE_H_
+
+#include <stddef.h>
+
+// Model of the Arduino AVR Wire library: same 32-byte transmit buffer,
+// and endTransmission() blocks for as long as the bytes take on the bus
+#define BUFFER_LENGTH 32
+
+class TwoWire {
+public:
+    void begin(void);
+    void setClock(unsigned long clock);
+    void beginTransmission(unsigned char address);
+    size_t write(unsigned char data);
+    unsigned char endTransmission(void);
+};
+
+extern TwoWire Wire;
+
+#endif